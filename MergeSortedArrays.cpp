@@ -1,7 +1,18 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <random>
+#include <ranges>
+#include <string>
+
+#include "adaptive_merge.h"
+#include "compressed_run.h"
+#include "merge_heap.h"
+#include "merged_view.h"
 
 // 测试数据
 class InputData {
@@ -31,61 +42,30 @@ class InputData {
   std::vector<std::vector<int>> arrays_;
 };
 
-// 简易的Iterator
-class ArrayIterator {
- public:
-  ArrayIterator()
-      : current_(nullptr),
-        end_(nullptr) {}
-
-  ArrayIterator(const std::vector<int> &array)
-      : current_(array.data()),
-        end_(current_ + array.size()) {}
-
-  inline int value() const {
-    return *current_;
-  }
-
-  inline void next() {
-    ++current_;
-  }
-
-  inline bool valid() const {
-    return current_ < end_;
-  }
-
-  inline bool operator<(const ArrayIterator &other) const {
-    return *current_< *other.current_;
-  }
-
- private:
-  const int *current_;
-  const int * const end_;
-};
-
-using ArrayIteratorPointer = ArrayIterator*;
-
-template <bool greater>
-struct ArrayIteratorPointerComparator {
-  inline bool operator()(const ArrayIteratorPointer &lhs,
-                         const ArrayIteratorPointer &rhs) const {
-    return greater ^ (*lhs < *rhs);
+// 低基数测试数据：每个run的元素都取自 [0, num_distinct)
+std::vector<std::vector<int>> LowCardinalityInput(
+    const std::size_t num_arrays,
+    const std::size_t num_elements_per_array,
+    const int num_distinct) {
+  std::mt19937 rng(num_arrays);
+  std::uniform_int_distribution<int> dist(0, num_distinct - 1);
+  std::vector<std::vector<int>> arrays(num_arrays);
+  for (auto &array : arrays) {
+    array.reserve(num_elements_per_array);
+    for (std::size_t j = 0; j < num_elements_per_array; ++j) {
+      array.emplace_back(dist(rng));
+    }
+    std::sort(array.begin(), array.end());
   }
-};
-
+  return arrays;
+}
 
-// 拼接数组，直接用std::sort
+// 拼接数组，直接用std::sort（实现见adaptive_merge.h中的ConcatSortMerge）
 void TestStdSort(const std::vector<std::vector<int>> &arrays,
                  std::vector<int> *output) {
-  int *dst = output->data();
-  for (const auto &array : arrays) {
-    std::memcpy(dst, array.data(), array.size() * sizeof(int));
-    dst += array.size();
-  }
-  std::sort(output->data(), dst);
+  ConcatSortMerge(arrays, output);
 }
 
-
 // 使用Priority Queue的写法
 void TestPriorityQueue(const std::vector<std::vector<int>> &arrays,
                        std::vector<int> *output) {
@@ -113,90 +93,75 @@ void TestPriorityQueue(const std::vector<std::vector<int>> &arrays,
   }
 }
 
+// 自定义Heap的写法（实现见adaptive_merge.h中的HeapMerge）
+void TestCustomizedHeap(const std::vector<std::vector<int>> &arrays,
+                        std::vector<int> *output) {
+  HeapMerge(arrays, output);
+}
 
-// 自定义Heap的写法：
-class MergeHeap {
- public:
-  using ArrayIteratorPointer = ArrayIterator*;
-
-  MergeHeap(std::vector<ArrayIterator> *iterators) {
-    heap_.reserve(iterators->size());
-    for (ArrayIterator &it : *iterators) {
-      heap_.emplace_back(&it);
-    }
-    std::sort(heap_.begin(), heap_.end(),
-              ArrayIteratorPointerComparator<false>());
+// 压缩run上的自定义Heap：每个游标边归并边逐block解码
+void TestCompressedHeap(const std::vector<CompressedRun> &runs,
+                        std::vector<int> *output) {
+  const std::size_t num_runs = runs.size();
+  std::vector<CompressedRunIterator> iterators;
+  iterators.reserve(num_runs);
+  for (std::size_t i = 0; i < num_runs; ++i) {
+    iterators.emplace_back(runs[i]);
   }
 
-  inline bool empty() const {
-    return heap_.empty();
+  BasicMergeHeap<CompressedRunIterator> heap(&iterators);
+  int* dst = output->data();
+  while (!heap.empty()) {
+    *(dst++) = heap.next();
   }
+}
 
-  inline int next() {
-    const ArrayIteratorPointer &top = heap_.front();
-    const int value = top->value();
-    top->next();
-    if (!top->valid()) {
-      heap_.front() = heap_.back();
-      heap_.pop_back();
-    }
-    if (heap_.size() > 1) {
-      siftDown();
-    }
-    return value;
+// 同上，但输出也以压缩格式写出
+void TestCompressedHeapCompressedOutput(const std::vector<CompressedRun> &runs,
+                                        CompressedRun *output) {
+  const std::size_t num_runs = runs.size();
+  std::vector<CompressedRunIterator> iterators;
+  iterators.reserve(num_runs);
+  for (std::size_t i = 0; i < num_runs; ++i) {
+    iterators.emplace_back(runs[i]);
   }
 
- private:
-  inline void siftDown() {
-    const ArrayIteratorPointer node = heap_.front();
-    const std::size_t n = heap_.size();
-    const std::size_t b = n >> 1;
-    std::size_t k = 0;
-    while (k < b) {
-      const std::size_t l = (k << 1) + 1;
-      const ArrayIteratorPointer lnode = heap_[l];
-
-      const std::size_t r = l + 1;
-      ArrayIteratorPointer rnode;
-      if (r >= n || *lnode < *(rnode = heap_[r])) {
-        if (*lnode < *node) {
-          heap_[k] = lnode;
-          k = l;
-        } else {
-          break;
-        }
-      } else {
-        if (*rnode < *node) {
-          heap_[k] = rnode;
-          k = r;
-        } else {
-          break;
-        }
-      }
-    }
-    heap_[k] = node;
+  BasicMergeHeap<CompressedRunIterator> heap(&iterators);
+  while (!heap.empty()) {
+    output->push_back(heap.next());
   }
+  output->flush();
+}
 
-  std::vector<ArrayIteratorPointer> heap_;
-};
+// 惰性归并视图：不预先分配输出，这里仅为校验才拷贝到output
+void TestMergedView(const std::vector<std::vector<int>> &arrays,
+                    std::vector<int> *output) {
+  std::ranges::copy(MergedView(arrays), output->begin());
+}
 
-void TestCustomizedHeap(const std::vector<std::vector<int>> &arrays,
-                        std::vector<int> *output) {
-  const std::size_t num_arrays = arrays.size();
-  std::vector<ArrayIterator> iterators;
-  iterators.reserve(num_arrays);
-  for (std::size_t i = 0; i < num_arrays; ++i) {
-    iterators.emplace_back(arrays[i]);
+// 与归并融合的下游算子：只累加偶数，不物化任何中间结果
+std::int64_t TestMergedViewSumOfEvens(
+    const std::vector<std::vector<int>> &arrays) {
+  std::int64_t sum = 0;
+  for (const int value : MergedView(arrays) |
+                             std::views::filter([](const int value) {
+                               return (value & 1) == 0;
+                             })) {
+    sum += value;
   }
+  return sum;
+}
 
-  MergeHeap heap(&iterators);
-  int* dst = output->data();
-  while (!heap.empty()) {
-    *(dst++) = heap.next();
+// 提前终止：只为取出的前num_elements个元素付出归并的代价
+std::int64_t TestMergedViewTake(const std::vector<std::vector<int>> &arrays,
+                                const std::size_t num_elements) {
+  std::int64_t sum = 0;
+  for (const int value : MergedView(arrays) | std::views::take(num_elements)) {
+    sum += value;
   }
+  return sum;
 }
 
-
 void ValidateOutput(const std::vector<int> &output) {
   std::cout << "Validating output ... ";
   for (std::size_t i = 0; i < output.size(); ++i) {
@@ -208,6 +173,31 @@ void ValidateOutput(const std::vector<int> &output) {
   std::cout << "PASS\n";
 }
 
+// 自适应归并至少不应选中实测最慢的策略
+void ValidateChoice(const MergeStrategy chosen,
+                    const double (&seconds)[kNumMergeStrategies]) {
+  std::cout << "Validating choice ... ";
+  const std::size_t slowest =
+      std::max_element(std::begin(seconds), std::end(seconds)) -
+      std::begin(seconds);
+  if (static_cast<std::size_t>(chosen) == slowest) {
+    std::cout << "FAIL: " << "chose " << MergeStrategyName(chosen)
+              << ", the slowest strategy\n";
+    return;
+  }
+  std::cout << "PASS\n";
+}
+
+void ValidateSum(const std::int64_t sum, const std::int64_t expected) {
+  std::cout << "Validating output ... ";
+  if (sum != expected) {
+    std::cout << "FAIL: " << "sum == " << sum << ", expected " << expected
+              << "\n";
+    return;
+  }
+  std::cout << "PASS\n";
+}
+
 int main(int argc, char *argv[]) {
   const std::size_t num_arrays = 1024;
   const std::size_t num_elements_per_array = 65536;
@@ -251,4 +241,147 @@ int main(int argc, char *argv[]) {
                    std::chrono::duration<double>>(end_time - start_time).count()
             << " seconds \n";
   ValidateOutput(output);
+
+  std::vector<CompressedRun> compressed;
+  compressed.reserve(num_arrays);
+  std::size_t compressed_bytes = 0;
+  for (const auto &array : data.arrays()) {
+    compressed.emplace_back(array);
+    compressed_bytes += compressed.back().bytes();
+  }
+  std::cout << "----\nCompressed input: " << compressed_bytes << " bytes ("
+            << sizeof(int) * total_num_elements << " bytes raw)\n";
+
+  std::cout << "----\nTesting with customized heap on compressed runs ...\n";
+  std::memset(output.data(), 0, sizeof(int) * total_num_elements);
+  start_time = clock::now();
+  TestCompressedHeap(compressed, &output);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  ValidateOutput(output);
+
+  std::cout << "----\nTesting with customized heap on compressed runs "
+            << "(compressed output) ...\n";
+  CompressedRun compressed_output;
+  start_time = clock::now();
+  TestCompressedHeapCompressedOutput(compressed, &compressed_output);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds, " << compressed_output.bytes() << " bytes\n";
+  compressed_output.decode(&output);
+  ValidateOutput(output);
+
+  std::cout << "----\nTesting with lazy merged view ...\n";
+  std::memset(output.data(), 0, sizeof(int) * total_num_elements);
+  start_time = clock::now();
+  TestMergedView(data.arrays(), &output);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  ValidateOutput(output);
+
+  std::cout << "----\nTesting with lazy merged view | filter (sum) ...\n";
+  start_time = clock::now();
+  const std::int64_t sum_of_evens = TestMergedViewSumOfEvens(data.arrays());
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  const std::int64_t num_evens = total_num_elements / 2;
+  ValidateSum(sum_of_evens, num_evens * (num_evens - 1));
+
+  const std::size_t num_taken = 1000;
+  std::cout << "----\nTesting with lazy merged view | take(" << num_taken
+            << ") ...\n";
+  start_time = clock::now();
+  const std::int64_t sum_of_taken = TestMergedViewTake(data.arrays(), num_taken);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  ValidateSum(sum_of_taken, num_taken * (num_taken - 1) / 2);
+
+  const std::string cost_model_path = "merge_cost_model.txt";
+  MergeCostModel model;
+  std::cout << "----\nLoading merge cost model ...";
+  start_time = clock::now();
+  const bool cached = model.loadOrCalibrate(cost_model_path);
+  end_time = clock::now();
+  std::cout << (cached ? " loaded from " : " calibrated and saved to ")
+            << cost_model_path << " in "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+
+  const MergeInputFeatures features = SampleMergeInput(data.arrays());
+  std::cout << "Input features: runs = " << features.num_runs
+            << ", length spread = " << features.length_spread
+            << ", overlap = " << features.overlap
+            << ", duplicate rate = " << features.duplicate_rate
+            << ", distinct values = " << features.distinct_values << "\n";
+
+  for (const MergeStrategy strategy : { MergeStrategy::kTournament,
+                                        MergeStrategy::kPairwiseTree,
+                                        MergeStrategy::kGalloping,
+                                        MergeStrategy::kParallelPartitioned }) {
+    std::cout << "----\nTesting with " << MergeStrategyName(strategy)
+              << " (predicted " << model.cost(strategy, features)
+              << " seconds) ...\n";
+    std::memset(output.data(), 0, sizeof(int) * total_num_elements);
+    start_time = clock::now();
+    RunMergeStrategy(strategy, data.arrays(), &output);
+    end_time = clock::now();
+    std::cout << "Elapsed time: "
+              << std::chrono::duration_cast<
+                     std::chrono::duration<double>>(end_time - start_time).count()
+              << " seconds \n";
+    ValidateOutput(output);
+  }
+
+  std::cout << "----\nTesting with adaptive merge ...\n";
+  std::memset(output.data(), 0, sizeof(int) * total_num_elements);
+  start_time = clock::now();
+  const MergeStrategy chosen = AdaptiveMerge(data.arrays(), &output, model);
+  end_time = clock::now();
+  std::cout << "Chose " << MergeStrategyName(chosen) << ", elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  ValidateOutput(output);
+
+  for (const std::size_t num_low_cardinality_arrays : { 8, 2 }) {
+    const std::size_t num_low_cardinality_elements = (8 << 20);
+    std::cout << "----\nTesting adaptive merge on low-cardinality input ("
+              << num_low_cardinality_arrays << " runs, values in [0, 100)) "
+              << "...\n";
+    const auto low_cardinality = LowCardinalityInput(
+        num_low_cardinality_arrays,
+        num_low_cardinality_elements / num_low_cardinality_arrays, 100);
+    std::vector<int> low_cardinality_output(num_low_cardinality_elements);
+    double seconds[kNumMergeStrategies];
+    for (std::size_t s = 0; s < kNumMergeStrategies; ++s) {
+      const MergeStrategy strategy = static_cast<MergeStrategy>(s);
+      start_time = clock::now();
+      RunMergeStrategy(strategy, low_cardinality, &low_cardinality_output);
+      end_time = clock::now();
+      seconds[s] = std::chrono::duration_cast<
+          std::chrono::duration<double>>(end_time - start_time).count();
+      std::cout << MergeStrategyName(strategy) << ": " << seconds[s]
+                << " seconds \n";
+    }
+    const MergeStrategy low_cardinality_chosen =
+        model.choose(SampleMergeInput(low_cardinality));
+    std::cout << "Chose " << MergeStrategyName(low_cardinality_chosen)
+              << "\n";
+    ValidateChoice(low_cardinality_chosen, seconds);
+  }
 }
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <execution>  // libstdc++的std::execution::par需要链接TBB (-ltbb)
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "multiseq_partition.h"
+
+// 每个chunk 64K个int (256 KiB)，可以完整放入L2 cache。
+constexpr std::size_t kChunkSize = 1 << 16;
+
+// 并行排序：
+//   (1) 各线程独立地对cache大小的chunk做std::sort；
+//   (2) 两两归并：每一轮把相邻的run两两归并，在data与scratch之间交替写入，
+//       共ceil(log2(chunk数))轮。每一轮的输出按rank均分成num_threads段，
+//       线程对与自己的段相交的每一对run，用多序列划分找到两个输入run中
+//       对应的起止位置，再用std::merge写出；
+//   (3) 结果落在scratch中时交换data与scratch。
+// 每个元素每轮只做一次顺序的二路比较，比num_chunks路的堆归并便宜得多。
+// scratch由调用方持有并在多次调用间复用，只在容量不足时才会重新分配。
+// 只有一个线程（num_threads为0时按1处理）时分块再归并只会更慢，
+// 直接退化为std::sort。
+void ParallelSort(std::vector<int> *data,
+                  std::vector<int> *scratch,
+                  const std::size_t num_threads) {
+  const std::size_t n = data->size();
+  if (n <= kChunkSize || num_threads <= 1) {
+    std::sort(data->begin(), data->end());
+    return;
+  }
+
+  int *base = data->data();
+  const std::size_t num_chunks = (n + kChunkSize - 1) / kChunkSize;
+  RunInParallel(num_threads, [&](const std::size_t t) {
+    for (std::size_t c = t; c < num_chunks; c += num_threads) {
+      std::sort(base + c * kChunkSize,
+                base + std::min(n, (c + 1) * kChunkSize));
+    }
+  });
+
+  // 相邻的run在src中首尾相接，所以一对run归并后在dst中的位置与它们在src
+  // 中的位置相同。
+  std::vector<std::size_t> bounds;
+  bounds.reserve(num_chunks + 1);
+  for (std::size_t c = 0; c < num_chunks; ++c) {
+    bounds.emplace_back(c * kChunkSize);
+  }
+  bounds.emplace_back(n);
+
+  scratch->resize(n);
+  int *src = base;
+  int *dst = scratch->data();
+  while (bounds.size() > 2) {
+    const std::size_t num_runs = bounds.size() - 1;
+    RunInParallel(num_threads, [&](const std::size_t t) {
+      const std::size_t begin_rank = t * n / num_threads;
+      const std::size_t end_rank = (t + 1) * n / num_threads;
+      std::vector<Run> pair;
+      std::vector<const int*> begins, ends;
+      for (std::size_t i = 0; i < num_runs; i += 2) {
+        const std::size_t first = bounds[i];
+        const std::size_t last = bounds[std::min(i + 2, num_runs)];
+        if (last <= begin_rank || first >= end_rank) {
+          continue;
+        }
+        const std::size_t lo = std::max(first, begin_rank) - first;
+        const std::size_t hi = std::min(last, end_rank) - first;
+        if (i + 1 == num_runs) {
+          std::copy(src + first + lo, src + first + hi, dst + first + lo);
+          continue;
+        }
+        pair.assign({ Run(src + first, src + bounds[i + 1]),
+                      Run(src + bounds[i + 1], src + last) });
+        MultiSequenceSplit(pair, lo, &begins);
+        MultiSequenceSplit(pair, hi, &ends);
+        std::merge(begins[0], ends[0], begins[1], ends[1], dst + first + lo);
+      }
+    });
+
+    std::vector<std::size_t> merged;
+    merged.reserve(num_runs / 2 + 2);
+    for (std::size_t i = 0; i < num_runs; i += 2) {
+      merged.emplace_back(bounds[i]);
+    }
+    merged.emplace_back(n);
+    bounds.swap(merged);
+    std::swap(src, dst);
+  }
+
+  if (src != base) {
+    data->swap(*scratch);
+  }
+}
+
+
+// 测试数据
+class InputData {
+ public:
+  InputData(const std::size_t num_elements) {
+    std::cout << "Initializing input data ...";
+    std::mt19937 rng(num_elements);
+    std::uniform_int_distribution<int> dist(std::numeric_limits<int>::min(),
+                                            std::numeric_limits<int>::max());
+    values_.reserve(num_elements);
+    for (std::size_t i = 0; i < num_elements; ++i) {
+      values_.emplace_back(dist(rng));
+    }
+    std::cout << " done\n";
+    std::flush(std::cout);
+  }
+
+  const std::vector<int>& values() const {
+    return values_;
+  }
+
+ private:
+  std::vector<int> values_;
+};
+
+
+void ValidateOutput(const std::vector<int> &expected,
+                    const std::vector<int> &output) {
+  std::cout << "Validating output ... ";
+  if (output.size() != expected.size()) {
+    std::cout << "FAIL: " << "output.size() == " << output.size() << "\n";
+    return;
+  }
+  for (std::size_t i = 0; i < output.size(); ++i) {
+    if (output[i] != expected[i]) {
+      std::cout << "FAIL: " << "output[" << i << "] == " << output[i] << "\n";
+      return;
+    }
+  }
+  std::cout << "PASS\n";
+}
+
+template <typename Functor>
+void Measure(const Functor &functor) {
+  using clock = std::chrono::high_resolution_clock;
+  const clock::time_point start_time = clock::now();
+  functor();
+  const clock::time_point end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+}
+
+int main(int argc, char *argv[]) {
+  const std::size_t num_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  std::vector<int> scratch;
+
+  for (const std::size_t num_elements : { 1u << 20, 1u << 24, 1u << 26 }) {
+    std::cout << "====\n" << num_elements << " elements\n";
+    InputData data(num_elements);
+
+    std::cout << "----\nTesting with std::sort ...\n";
+    std::vector<int> expected = data.values();
+    Measure([&]() {
+      std::sort(expected.begin(), expected.end());
+    });
+
+    std::cout << "----\nTesting with std::sort(std::execution::par) ...\n";
+    std::vector<int> output = data.values();
+    Measure([&]() {
+      std::sort(std::execution::par, output.begin(), output.end());
+    });
+    ValidateOutput(expected, output);
+
+    std::cout << "----\nTesting with parallel chunk sort + merge ("
+              << num_threads << " threads"
+              << (num_threads <= 1 ? ", falls back to std::sort" : "")
+              << ") ...\n";
+    output = data.values();
+    Measure([&]() {
+      ParallelSort(&output, &scratch, num_threads);
+    });
+    ValidateOutput(expected, output);
+  }
+
+  return 0;
+}
@@ -0,0 +1,458 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 轴对齐矩形，闭区间 [x1, x2] x [y1, y2]，边界相接也视为相交。
+struct Rectangle {
+  int x1;
+  int y1;
+  int x2;
+  int y2;
+
+  inline bool intersects(const Rectangle &other) const {
+    return x1 <= other.x2 && other.x1 <= x2 &&
+           y1 <= other.y2 && other.y1 <= y2;
+  }
+};
+
+
+// 并查集：路径减半 + 按大小合并
+class UnionFind {
+ public:
+  explicit UnionFind(const std::size_t size)
+      : parent_(size),
+        size_(size, 1) {
+    std::iota(parent_.begin(), parent_.end(), 0);
+  }
+
+  inline int find(int x) {
+    while (parent_[x] != x) {
+      parent_[x] = parent_[parent_[x]];
+      x = parent_[x];
+    }
+    return x;
+  }
+
+  inline void unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+      return;
+    }
+    if (size_[a] < size_[b]) {
+      std::swap(a, b);
+    }
+    parent_[b] = a;
+    size_[a] += size_[b];
+  }
+
+  // 按首次出现的顺序将分量编号为 0..C-1，返回分量数C。
+  std::size_t labels(std::vector<int> *output) {
+    const std::size_t n = parent_.size();
+    std::vector<int> root_label(n, -1);
+    output->resize(n);
+    int num_labels = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      int &label = root_label[find(i)];
+      if (label < 0) {
+        label = num_labels++;
+      }
+      (*output)[i] = label;
+    }
+    return num_labels;
+  }
+
+ private:
+  std::vector<int> parent_;
+  std::vector<int> size_;
+};
+
+
+// 扫描线上的活动区间结构：建立在离散化y坐标上的线段树。
+//
+// 每个活动矩形按y区间分解到O(log n)个规范节点上。两个矩形的y区间相交，
+// 当且仅当其中一个的某个规范节点是另一个的某个规范节点的祖先（或相同）。
+// 因此插入矩形时只需：
+//   (1) 与沿途祖先节点上存放的矩形合并；
+//   (2) 与规范节点子树内所有活动矩形合并。
+// 节点上存放的矩形必然两两相交，所以只需记录一个代表。对(2)，每个节点
+// 维护subtree_rep：非负时表示子树内所有活动矩形都已在它所在的分量中
+// (clean)，此时一次合并即可，不必下探；为kDirty时需要下探。插入只会把
+// O(log n)个祖先标记为dirty，而每次下探都会把dirty节点清理为clean，故总
+// 代价为O(n log n)。删除只会缩小集合，不破坏上述不变量。
+//
+// 节点上存放有矩形时 (cover_count > 0)，子树内的活动矩形在插入时都已与
+// 它们合并，子树必然是clean的，所以节点上的代表直接用subtree_rep，不再
+// 单独记录。
+//
+// 叶子数取不小于num_points的2的幂，节点数为2 * 叶子数，每个节点12字节。
+class SweepIntervalTree {
+ public:
+  SweepIntervalTree(const std::size_t num_points, UnionFind *uf)
+      : num_leaves_(NumLeaves(num_points)),
+        nodes_(2 * num_leaves_),
+        uf_(uf) {}
+
+  // 插入y下标区间 [lo, hi]，并与所有相交的活动矩形合并。
+  inline void insert(const int id, const int lo, const int hi) {
+    insert(1, 0, num_leaves_ - 1, lo, hi, id);
+  }
+
+  inline void erase(const int lo, const int hi) {
+    erase(1, 0, num_leaves_ - 1, lo, hi);
+  }
+
+ private:
+  static constexpr int kDirty = -1;
+
+  struct Node {
+    int cover_count = 0;
+    int subtree_count = 0;
+    int subtree_rep = kDirty;
+  };
+
+  static int NumLeaves(const std::size_t num_points) {
+    int num_leaves = 1;
+    while (static_cast<std::size_t>(num_leaves) < num_points) {
+      num_leaves <<= 1;
+    }
+    return num_leaves;
+  }
+
+  void insert(const int k, const int l, const int r,
+              const int lo, const int hi, const int id) {
+    Node &node = nodes_[k];
+    if (lo <= l && r <= hi) {
+      collect(k, l, r, id);
+      ++node.cover_count;
+      ++node.subtree_count;
+      node.subtree_rep = id;
+      return;
+    }
+    if (node.cover_count > 0) {
+      uf_->unite(id, node.subtree_rep);
+    }
+    const int m = (l + r) >> 1;
+    if (lo <= m) {
+      insert(k << 1, l, m, lo, hi, id);
+    }
+    if (hi > m) {
+      insert((k << 1) | 1, m + 1, r, lo, hi, id);
+    }
+    ++node.subtree_count;
+    node.subtree_rep = node.cover_count > 0 ? id : kDirty;
+  }
+
+  void collect(const int k, const int l, const int r, const int id) {
+    Node &node = nodes_[k];
+    if (node.subtree_count == 0) {
+      return;
+    }
+    if (node.subtree_rep != kDirty) {
+      uf_->unite(id, node.subtree_rep);
+      return;
+    }
+    const int m = (l + r) >> 1;
+    collect(k << 1, l, m, id);
+    collect((k << 1) | 1, m + 1, r, id);
+    node.subtree_rep = id;
+  }
+
+  void erase(const int k, const int l, const int r,
+             const int lo, const int hi) {
+    Node &node = nodes_[k];
+    --node.subtree_count;
+    if (lo <= l && r <= hi) {
+      --node.cover_count;
+      return;
+    }
+    const int m = (l + r) >> 1;
+    if (lo <= m) {
+      erase(k << 1, l, m, lo, hi);
+    }
+    if (hi > m) {
+      erase((k << 1) | 1, m + 1, r, lo, hi);
+    }
+  }
+
+  const int num_leaves_;
+  std::vector<Node> nodes_;
+  UnionFind *uf_;
+};
+
+
+// 将 (坐标, 下标) 打包为可直接排序的64位键：高32位为翻转符号位后的坐标。
+inline std::uint64_t SortKey(const int coordinate, const std::size_t index) {
+  return (static_cast<std::uint64_t>(
+              static_cast<std::uint32_t>(coordinate) ^ 0x80000000u) << 32) |
+         index;
+}
+
+// 对rects做x方向扫描，结果以矩形下标写入uf。
+void Sweep(const std::vector<Rectangle> &rects, UnionFind *uf) {
+  const std::size_t n = rects.size();
+  if (n == 0) {
+    return;
+  }
+
+  std::vector<int> ys;
+  ys.reserve(2 * n);
+  for (const Rectangle &rect : rects) {
+    ys.emplace_back(rect.y1);
+    ys.emplace_back(rect.y2);
+  }
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  std::vector<std::pair<int, int>> spans(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    spans[i].first =
+        std::lower_bound(ys.begin(), ys.end(), rects[i].y1) - ys.begin();
+    spans[i].second =
+        std::lower_bound(ys.begin(), ys.end(), rects[i].y2) - ys.begin();
+  }
+
+  std::vector<std::uint64_t> by_x1(n);
+  std::vector<std::uint64_t> by_x2(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    by_x1[i] = SortKey(rects[i].x1, i);
+    by_x2[i] = SortKey(rects[i].x2, i);
+  }
+  std::sort(by_x1.begin(), by_x1.end());
+  std::sort(by_x2.begin(), by_x2.end());
+
+  SweepIntervalTree tree(ys.size(), uf);
+  std::size_t num_erased = 0;
+  for (const std::uint64_t key : by_x1) {
+    // 先删除完全位于当前矩形左侧的活动矩形 (x2 < x1)
+    while ((by_x2[num_erased] >> 32) < (key >> 32)) {
+      const int j = static_cast<std::uint32_t>(by_x2[num_erased++]);
+      tree.erase(spans[j].first, spans[j].second);
+    }
+    const int i = static_cast<std::uint32_t>(key);
+    tree.insert(i, spans[i].first, spans[i].second);
+  }
+}
+
+
+// 单线程版本：返回连通分量数，labels[i]为第i个矩形的分量编号。
+std::size_t RectangleComponents(const std::vector<Rectangle> &rects,
+                                std::vector<int> *labels) {
+  UnionFind uf(rects.size());
+  Sweep(rects, &uf);
+  return uf.labels(labels);
+}
+
+
+// 多线程版本：按x1的分位数把平面切成num_strips个竖直条带，
+// 每个矩形被分配到它x区间覆盖的所有条带。两个相交矩形必然同时出现在
+// 包含它们交集左边界的条带中，因此各条带独立扫描后，再通过跨越边界的
+// 矩形在全局并查集中合并即可得到正确的分量。
+std::size_t ParallelRectangleComponents(const std::vector<Rectangle> &rects,
+                                        const std::size_t num_strips,
+                                        std::vector<int> *labels) {
+  const std::size_t n = rects.size();
+  if (num_strips <= 1 || n < num_strips) {
+    return RectangleComponents(rects, labels);
+  }
+
+  // 条带s覆盖 [bounds[s-1], bounds[s])，首尾条带向外无界。
+  std::vector<int> xs(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    xs[i] = rects[i].x1;
+  }
+  std::vector<int> bounds;
+  bounds.reserve(num_strips - 1);
+  for (std::size_t s = 1; s < num_strips; ++s) {
+    const auto nth = xs.begin() + s * n / num_strips;
+    std::nth_element(xs.begin(), nth, xs.end());
+    bounds.emplace_back(*nth);
+  }
+  std::sort(bounds.begin(), bounds.end());
+
+  std::vector<std::vector<int>> strip_ids(num_strips);
+  std::vector<std::vector<int>> strip_roots(num_strips);
+  std::vector<std::thread> threads;
+  threads.reserve(num_strips);
+  for (std::size_t s = 0; s < num_strips; ++s) {
+    threads.emplace_back([&, s]() {
+      const int lower = s == 0 ? std::numeric_limits<int>::min()
+                               : bounds[s - 1];
+      const int upper = s + 1 == num_strips ? std::numeric_limits<int>::max()
+                                            : bounds[s];
+      std::vector<int> &ids = strip_ids[s];
+      std::vector<Rectangle> strip;
+      for (std::size_t i = 0; i < n; ++i) {
+        const Rectangle &rect = rects[i];
+        if (rect.x2 >= lower && (rect.x1 < upper || s + 1 == num_strips)) {
+          ids.emplace_back(i);
+          strip.emplace_back(rect);
+        }
+      }
+
+      UnionFind uf(strip.size());
+      Sweep(strip, &uf);
+
+      std::vector<int> &roots = strip_roots[s];
+      roots.resize(ids.size());
+      for (std::size_t i = 0; i < ids.size(); ++i) {
+        roots[i] = ids[uf.find(i)];
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  UnionFind uf(n);
+  for (std::size_t s = 0; s < num_strips; ++s) {
+    const std::vector<int> &ids = strip_ids[s];
+    const std::vector<int> &roots = strip_roots[s];
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      uf.unite(ids[i], roots[i]);
+    }
+  }
+  return uf.labels(labels);
+}
+
+
+// 测试数据
+class InputData {
+ public:
+  // 在 [0, extent)^2 内均匀分布，边长在 [1, max_side] 内。
+  static std::vector<Rectangle> Random(const std::size_t num_rects,
+                                       const int extent,
+                                       const int max_side,
+                                       const std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> position(0, extent - 1);
+    std::uniform_int_distribution<int> side(1, max_side);
+    std::vector<Rectangle> rects;
+    rects.reserve(num_rects);
+    for (std::size_t i = 0; i < num_rects; ++i) {
+      const int x = position(rng);
+      const int y = position(rng);
+      rects.push_back({x, y, x + side(rng), y + side(rng)});
+    }
+    return rects;
+  }
+
+  // 围绕num_clusters个随机中心呈正态分布的簇。
+  static std::vector<Rectangle> Clustered(const std::size_t num_rects,
+                                          const std::size_t num_clusters,
+                                          const int extent,
+                                          const double spread,
+                                          const int max_side,
+                                          const std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> position(0, extent - 1);
+    std::normal_distribution<double> offset(0.0, spread);
+    std::uniform_int_distribution<int> side(1, max_side);
+    std::vector<std::pair<int, int>> centers(num_clusters);
+    for (auto &center : centers) {
+      center = {position(rng), position(rng)};
+    }
+    std::uniform_int_distribution<std::size_t> cluster(0, num_clusters - 1);
+    std::vector<Rectangle> rects;
+    rects.reserve(num_rects);
+    for (std::size_t i = 0; i < num_rects; ++i) {
+      const auto &center = centers[cluster(rng)];
+      const int x = center.first + static_cast<int>(offset(rng));
+      const int y = center.second + static_cast<int>(offset(rng));
+      rects.push_back({x, y, x + side(rng), y + side(rng)});
+    }
+    return rects;
+  }
+};
+
+
+// 两两比较的暴力解法，仅用于在小规模数据上校验。
+std::size_t BruteForceComponents(const std::vector<Rectangle> &rects,
+                                 std::vector<int> *labels) {
+  UnionFind uf(rects.size());
+  for (std::size_t i = 0; i < rects.size(); ++i) {
+    for (std::size_t j = i + 1; j < rects.size(); ++j) {
+      if (rects[i].intersects(rects[j])) {
+        uf.unite(i, j);
+      }
+    }
+  }
+  return uf.labels(labels);
+}
+
+void ValidateOutput(const std::vector<int> &expected,
+                    const std::vector<int> &output) {
+  std::cout << "Validating output ... ";
+  for (std::size_t i = 0; i < output.size(); ++i) {
+    if (output[i] != expected[i]) {
+      std::cout << "FAIL: " << "output[" << i << "] == " << output[i]
+                << ", expected " << expected[i] << "\n";
+      return;
+    }
+  }
+  std::cout << "PASS\n";
+}
+
+void RunBenchmark(const char *name,
+                  const std::vector<Rectangle> &rects,
+                  const std::size_t num_strips) {
+  using clock = std::chrono::high_resolution_clock;
+  clock::time_point start_time, end_time;
+
+  std::cout << "----\n" << name << ": " << rects.size() << " rectangles\n";
+  std::cout << "Testing with sweep line ...\n";
+  std::vector<int> expected;
+  start_time = clock::now();
+  const std::size_t num_components = RectangleComponents(rects, &expected);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds, " << num_components << " components\n";
+
+  std::cout << "Testing with " << num_strips << " parallel strips ...\n";
+  std::vector<int> output;
+  start_time = clock::now();
+  ParallelRectangleComponents(rects, num_strips, &output);
+  end_time = clock::now();
+  std::cout << "Elapsed time: "
+            << std::chrono::duration_cast<
+                   std::chrono::duration<double>>(end_time - start_time).count()
+            << " seconds \n";
+  ValidateOutput(expected, output);
+}
+
+int main(int argc, char *argv[]) {
+  const std::size_t num_rects = 2000000;
+  const std::size_t num_strips =
+      std::max(2u, std::thread::hardware_concurrency());
+
+  std::cout << "----\nValidating sweep line against brute force ...\n";
+  for (const auto &rects :
+       { InputData::Random(3000, 10000, 300, 1),
+         InputData::Clustered(3000, 20, 10000, 200.0, 40, 2) }) {
+    std::vector<int> expected, output;
+    BruteForceComponents(rects, &expected);
+    RectangleComponents(rects, &output);
+    ValidateOutput(expected, output);
+    ParallelRectangleComponents(rects, 4, &output);
+    ValidateOutput(expected, output);
+  }
+
+  RunBenchmark("Random",
+               InputData::Random(num_rects, 1 << 20, 1024, 42),
+               num_strips);
+  RunBenchmark("Clustered",
+               InputData::Clustered(num_rects, 1000, 1 << 20, 3000.0, 256, 43),
+               num_strips);
+
+  return 0;
+}
@@ -8,6 +8,8 @@
 #include <utility>
 #include <vector>
 
+#include "meta.h"
+
 class Solution {
  public:
   std::vector<std::vector<std::string>> findLadders(
@@ -32,25 +34,15 @@ class Solution {
     }
 
     // Initialize the graph edges.
-    if (n < 65536 && m <= 5) {
-      switch (m) {
-        case 1: initEdgesCompCodePos<1u>(wordList, edges); break;
-        case 2: initEdgesCompCodePos<2u>(wordList, edges); break;
-        case 3: initEdgesCompCodePos<3u>(wordList, edges); break;
-        case 4: initEdgesCompCodePos<4u>(wordList, edges); break;
-        case 5: initEdgesCompCodePos<5u>(wordList, edges); break;
-      }
-    } else if (m <= 7) {
-      switch (m) {
-        case 1: initEdgesCompCode<1u, std::uint32_t>(wordList, edges); break;
-        case 2: initEdgesCompCode<2u, std::uint32_t>(wordList, edges); break;
-        case 3: initEdgesCompCode<3u, std::uint32_t>(wordList, edges); break;
-        case 4: initEdgesCompCode<4u, std::uint64_t>(wordList, edges); break;
-        case 5: initEdgesCompCode<5u, std::uint64_t>(wordList, edges); break;
-        case 6: initEdgesCompCode<6u, std::uint64_t>(wordList, edges); break;
-        case 7: initEdgesCompCode<7u, std::uint64_t>(wordList, edges); break;
-      }
-    } else {
+    const auto initPos = [&](auto len) {
+      initEdgesCompCodePos<decltype(len)::value>(wordList, edges);
+    };
+    const auto initCode = [&](auto len) {
+      constexpr std::size_t kLen = decltype(len)::value;
+      initEdgesCompCode<kLen, meta::UnsignedInteger<kLen + 1>>(wordList, edges);
+    };
+    if (!(n < 65536 && CompCodePosLengths::Dispatch(m, initPos)) &&
+        !CompCodeLengths::Dispatch(m, initCode)) {
       initEdges(wordList, edges);
     }
 
@@ -134,6 +126,11 @@ class Solution {
   }
 
  private:
+  // Word lengths with specialized edge builders. initEdgesCompCodePos packs
+  // (m + 3) bytes into a uint64_t; initEdgesCompCode needs (m + 1) bytes.
+  using CompCodePosLengths = meta::Sequence<std::size_t, 1, 2, 3, 4, 5>;
+  using CompCodeLengths = meta::Sequence<std::size_t, 1, 2, 3, 4, 5, 6, 7>;
+
   struct State {
     inline State(std::vector<std::string> &&ladder_in,
                  const std::vector<int>::iterator &iter_in,
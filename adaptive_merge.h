@@ -0,0 +1,913 @@
+#ifndef ADAPTIVE_MERGE_H_
+#define ADAPTIVE_MERGE_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "merge_heap.h"
+#include "multiseq_partition.h"
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////// 归并策略 //////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// 所有策略的接口与TestPriorityQueue相同：output已预先分配为全部元素的大小。
+
+enum class MergeStrategy {
+  kHeap,
+  kTournament,
+  kPairwiseTree,
+  kGalloping,
+  kConcatSort,
+  kParallelPartitioned,
+};
+
+constexpr std::size_t kNumMergeStrategies = 6;
+
+inline const char* MergeStrategyName(const MergeStrategy strategy) {
+  switch (strategy) {
+    case MergeStrategy::kHeap: return "heap";
+    case MergeStrategy::kTournament: return "tournament";
+    case MergeStrategy::kPairwiseTree: return "pairwise_tree";
+    case MergeStrategy::kGalloping: return "galloping";
+    case MergeStrategy::kConcatSort: return "concat_sort";
+    case MergeStrategy::kParallelPartitioned: return "parallel_partitioned";
+  }
+  return "unknown";
+}
+
+inline std::size_t MergeThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 自定义Heap的写法
+inline void HeapMerge(const std::vector<std::vector<int>> &arrays,
+                      std::vector<int> *output) {
+  std::vector<ArrayIterator> iterators;
+  iterators.reserve(arrays.size());
+  for (const auto &array : arrays) {
+    if (!array.empty()) {
+      iterators.emplace_back(array);
+    }
+  }
+
+  MergeHeap heap(&iterators);
+  int* dst = output->data();
+  while (!heap.empty()) {
+    *(dst++) = heap.next();
+  }
+}
+
+// 败者树：每个内部节点记录该场比赛的败者，winner_为全局胜者。
+// 每弹出一个元素恰好沿叶子到根比较ceil(log k)次，与数据分布无关。
+class LoserTree {
+ public:
+  LoserTree(std::vector<ArrayIterator> *iterators)
+      : iterators_(*iterators),
+        k_(iterators->size()),
+        tree_(k_ > 0 ? k_ : 1) {
+    winner_ = k_ > 0 ? build(1) : 0;
+  }
+
+  inline bool empty() const {
+    return k_ == 0 || !iterators_[winner_].valid();
+  }
+
+  inline int next() {
+    ArrayIterator &top = iterators_[winner_];
+    const int value = top.value();
+    top.next();
+    for (std::size_t node = (winner_ + k_) >> 1; node > 0; node >>= 1) {
+      if (beats(tree_[node], winner_)) {
+        std::swap(tree_[node], winner_);
+      }
+    }
+    return value;
+  }
+
+ private:
+  inline bool beats(const std::size_t lhs, const std::size_t rhs) const {
+    const ArrayIterator &l = iterators_[lhs];
+    const ArrayIterator &r = iterators_[rhs];
+    return !r.valid() || (l.valid() && l < r);
+  }
+
+  std::size_t build(const std::size_t node) {
+    if (node >= k_) {
+      return node - k_;
+    }
+    const std::size_t l = build(node << 1);
+    const std::size_t r = build((node << 1) | 1);
+    if (beats(l, r)) {
+      tree_[node] = r;
+      return l;
+    }
+    tree_[node] = l;
+    return r;
+  }
+
+  std::vector<ArrayIterator> &iterators_;
+  const std::size_t k_;
+  std::vector<std::size_t> tree_;
+  std::size_t winner_;
+};
+
+inline void TournamentMerge(const std::vector<std::vector<int>> &arrays,
+                            std::vector<int> *output) {
+  std::vector<ArrayIterator> iterators;
+  iterators.reserve(arrays.size());
+  for (const auto &array : arrays) {
+    if (!array.empty()) {
+      iterators.emplace_back(array);
+    }
+  }
+
+  LoserTree tree(&iterators);
+  int* dst = output->data();
+  while (!tree.empty()) {
+    *(dst++) = tree.next();
+  }
+}
+
+// 指数查找后二分：返回[first, last)中第一个不满足 *it < value 的位置
+// (strict == false) 或第一个不满足 *it <= value 的位置 (strict == true)。
+template <bool strict>
+inline const int* GallopSearch(const int *first, const int *last,
+                               const int value) {
+  const auto before = [value](const int x) {
+    return strict ? x <= value : x < value;
+  };
+  std::size_t step = 1;
+  const int *lo = first;
+  while (lo + step < last && before(lo[step])) {
+    lo += step;
+    step <<= 1;
+  }
+  const int *hi = std::min(lo + step, last);
+  return strict ? std::upper_bound(lo, hi, value)
+                : std::lower_bound(lo, hi, value);
+}
+
+// 二路归并，整段拷贝由指数查找确定的连续片段；run之间重叠越少越快。
+inline int* GallopingMerge2(const int *a, const int *a_end,
+                            const int *b, const int *b_end,
+                            int *dst) {
+  while (a < a_end && b < b_end) {
+    if (*b < *a) {
+      const int *b_run = GallopSearch<false>(b, b_end, *a);
+      std::memcpy(dst, b, (b_run - b) * sizeof(int));
+      dst += b_run - b;
+      b = b_run;
+    } else {
+      const int *a_run = GallopSearch<true>(a, a_end, *b);
+      std::memcpy(dst, a, (a_run - a) * sizeof(int));
+      dst += a_run - a;
+      a = a_run;
+    }
+  }
+  std::memcpy(dst, a, (a_end - a) * sizeof(int));
+  dst += a_end - a;
+  std::memcpy(dst, b, (b_end - b) * sizeof(int));
+  return dst + (b_end - b);
+}
+
+inline int* StdMerge2(const int *a, const int *a_end,
+                      const int *b, const int *b_end,
+                      int *dst) {
+  return std::merge(a, a_end, b, b_end, dst);
+}
+
+// 两两归并树：每一轮把相邻的run两两归并，在output与scratch之间交替写入，
+// 共ceil(log k)轮；轮数的奇偶决定首轮写到哪个缓冲区，保证最后一轮写入output。
+template <typename Merge2>
+inline void PairwiseTreeMerge(const std::vector<std::vector<int>> &arrays,
+                              std::vector<int> *output,
+                              const Merge2 &merge2) {
+  std::vector<Run> runs;
+  runs.reserve(arrays.size());
+  for (const auto &array : arrays) {
+    if (!array.empty()) {
+      runs.emplace_back(array.data(), array.data() + array.size());
+    }
+  }
+  if (runs.empty()) {
+    return;
+  }
+
+  std::size_t num_rounds = 0;
+  while ((std::size_t(1) << num_rounds) < runs.size()) {
+    ++num_rounds;
+  }
+  if (num_rounds == 0) {
+    std::memcpy(output->data(), runs.front().first,
+                (runs.front().second - runs.front().first) * sizeof(int));
+    return;
+  }
+
+  std::vector<int> scratch(num_rounds > 1 ? output->size() : 0);
+  for (std::size_t round = 1; round <= num_rounds; ++round) {
+    int *dst = (num_rounds - round) % 2 == 0 ? output->data()
+                                             : scratch.data();
+    std::vector<Run> merged;
+    merged.reserve((runs.size() + 1) / 2);
+    for (std::size_t i = 0; i < runs.size(); i += 2) {
+      int *end;
+      if (i + 1 < runs.size()) {
+        end = merge2(runs[i].first, runs[i].second,
+                     runs[i + 1].first, runs[i + 1].second, dst);
+      } else {
+        const std::size_t size = runs[i].second - runs[i].first;
+        std::memcpy(dst, runs[i].first, size * sizeof(int));
+        end = dst + size;
+      }
+      merged.emplace_back(dst, end);
+      dst = end;
+    }
+    runs.swap(merged);
+  }
+}
+
+// 拼接数组，直接用std::sort
+inline void ConcatSortMerge(const std::vector<std::vector<int>> &arrays,
+                            std::vector<int> *output) {
+  int *dst = output->data();
+  for (const auto &array : arrays) {
+    if (array.empty()) {
+      continue;
+    }
+    std::memcpy(dst, array.data(), array.size() * sizeof(int));
+    dst += array.size();
+  }
+  std::sort(output->data(), dst);
+}
+
+// 用多序列划分把输出均分给各线程，每个线程用MergeHeap归并自己的部分。
+inline void ParallelPartitionedMerge(
+    const std::vector<std::vector<int>> &arrays,
+    std::vector<int> *output) {
+  std::vector<Run> runs;
+  runs.reserve(arrays.size());
+  std::size_t n = 0;
+  for (const auto &array : arrays) {
+    if (!array.empty()) {
+      runs.emplace_back(array.data(), array.data() + array.size());
+      n += array.size();
+    }
+  }
+
+  const std::size_t num_threads = MergeThreads();
+  RunInParallel(num_threads, [&](const std::size_t t) {
+    const std::size_t begin_rank = t * n / num_threads;
+    const std::size_t end_rank = (t + 1) * n / num_threads;
+    std::vector<const int*> begins, ends;
+    MultiSequenceSplit(runs, begin_rank, &begins);
+    MultiSequenceSplit(runs, end_rank, &ends);
+
+    std::vector<ArrayIterator> iterators;
+    iterators.reserve(runs.size());
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+      if (begins[i] < ends[i]) {
+        iterators.emplace_back(begins[i], ends[i]);
+      }
+    }
+
+    MergeHeap heap(&iterators);
+    int *dst = output->data() + begin_rank;
+    while (!heap.empty()) {
+      *(dst++) = heap.next();
+    }
+  });
+}
+
+inline void RunMergeStrategy(const MergeStrategy strategy,
+                             const std::vector<std::vector<int>> &arrays,
+                             std::vector<int> *output) {
+  switch (strategy) {
+    case MergeStrategy::kHeap:
+      HeapMerge(arrays, output);
+      break;
+    case MergeStrategy::kTournament:
+      TournamentMerge(arrays, output);
+      break;
+    case MergeStrategy::kPairwiseTree:
+      PairwiseTreeMerge(arrays, output, StdMerge2);
+      break;
+    case MergeStrategy::kGalloping:
+      PairwiseTreeMerge(arrays, output, GallopingMerge2);
+      break;
+    case MergeStrategy::kConcatSort:
+      ConcatSortMerge(arrays, output);
+      break;
+    case MergeStrategy::kParallelPartitioned:
+      ParallelPartitionedMerge(arrays, output);
+      break;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////// 输入采样 //////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+struct MergeInputFeatures {
+  // 非空run的个数
+  std::size_t num_runs = 0;
+  std::size_t num_elements = 0;
+  // 最长run的长度 / 平均长度
+  double length_spread = 1.0;
+  // 采样点平均落在多大比例的run的值域 [front, back] 内：
+  // 完全交错时为1，值域互不相交时约为1/k。
+  double overlap = 0.0;
+  // 采样的run内相邻元素相等的比例
+  double duplicate_rate = 0.0;
+  // 估计的不同值个数。由随机采样值按（偏差修正的）Chao1估计：
+  // d + f1 (f1 - 1) / (2 (f2 + 1))，d为采样中不同值的个数，f1、f2为恰好
+  // 出现一次、两次的值的个数；上限为run内值段的个数
+  // max(d, n * (1 - duplicate_rate))，采样中没有重复值时直接取该上限。
+  // 低基数输入上duplicate_rate会饱和为1，不能单独用它估计。
+  double distinct_values = 0.0;
+  // run内开始一个新值的元素比例，即 1 - duplicate_rate；下限为
+  // max(k, distinct_values) / n：每个run至少有一段，每个不同值至少开始
+  // 一段。
+  double new_value_rate = 1.0;
+};
+
+// 只读取每个run的首尾元素及少量采样位置，代价为O(k * kNumOverlapSamples)。
+inline MergeInputFeatures SampleMergeInput(
+    const std::vector<std::vector<int>> &arrays) {
+  constexpr std::size_t kNumOverlapSamples = 64;
+  constexpr std::size_t kNumDuplicateSamples = 1024;
+  constexpr std::size_t kNumDistinctSamples = 1024;
+
+  MergeInputFeatures features;
+  std::vector<const std::vector<int>*> runs;
+  std::size_t max_length = 0;
+  for (const auto &array : arrays) {
+    if (!array.empty()) {
+      runs.emplace_back(&array);
+      features.num_elements += array.size();
+      max_length = std::max(max_length, array.size());
+    }
+  }
+  const std::size_t k = runs.size();
+  features.num_runs = k;
+  if (k == 0) {
+    return features;
+  }
+  features.length_spread =
+      static_cast<double>(max_length) * k / features.num_elements;
+
+  std::mt19937 rng(k);
+  std::size_t num_covered = 0;
+  for (std::size_t s = 0; s < kNumOverlapSamples; ++s) {
+    const std::vector<int> &run = *runs[rng() % k];
+    const int value = run[rng() % run.size()];
+    for (const auto *other : runs) {
+      num_covered += other->front() <= value && value <= other->back();
+    }
+  }
+  features.overlap =
+      static_cast<double>(num_covered) / (kNumOverlapSamples * k);
+
+  std::size_t num_pairs = 0;
+  std::size_t num_duplicates = 0;
+  for (std::size_t s = 0; s < kNumDuplicateSamples; ++s) {
+    const std::vector<int> &run = *runs[rng() % k];
+    if (run.size() > 1) {
+      const std::size_t i = rng() % (run.size() - 1);
+      num_duplicates += run[i] == run[i + 1];
+      ++num_pairs;
+    }
+  }
+  features.duplicate_rate =
+      num_pairs > 0 ? static_cast<double>(num_duplicates) / num_pairs : 0.0;
+
+  std::vector<int> samples;
+  samples.reserve(kNumDistinctSamples);
+  for (std::size_t s = 0; s < kNumDistinctSamples; ++s) {
+    const std::vector<int> &run = *runs[rng() % k];
+    samples.emplace_back(run[rng() % run.size()]);
+  }
+  std::sort(samples.begin(), samples.end());
+  double num_sampled_distinct = 0.0;
+  double num_singletons = 0.0;
+  double num_doubletons = 0.0;
+  for (std::size_t i = 0; i < samples.size();) {
+    const std::size_t j =
+        std::upper_bound(samples.begin() + i, samples.end(), samples[i]) -
+        samples.begin();
+    ++num_sampled_distinct;
+    num_singletons += j - i == 1;
+    num_doubletons += j - i == 2;
+    i = j;
+  }
+  const double n = features.num_elements;
+  const double num_segments = std::min(
+      n, std::max(num_sampled_distinct, n * (1.0 - features.duplicate_rate)));
+  features.distinct_values =
+      num_singletons == samples.size()
+          ? num_segments
+          : std::min(num_segments,
+                     num_sampled_distinct +
+                         num_singletons * (num_singletons - 1.0) /
+                             (2.0 * (num_doubletons + 1.0)));
+  features.new_value_rate =
+      std::min(1.0, std::max(1.0 - features.duplicate_rate,
+                             std::max<double>(k, features.distinct_values) /
+                                 n));
+  return features;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////// 代价模型 //////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// 每个策略的预测耗时为kNumTerms个特征项的线性组合 c0 x0 + c1 x1 + ...，
+// 系数由calibrate()在本机上用非负最小二乘拟合，并以文本形式缓存到文件中。
+
+class MergeCostModel {
+ public:
+  static constexpr std::size_t kNumTerms = 5;
+
+  MergeCostModel() {
+    for (auto &coefficients : coefficients_) {
+      coefficients.fill(0.0);
+    }
+  }
+
+  // 该策略的特征项，用不到的项为0。单独的k项是每个run的固定开销（建立
+  // 游标、建堆等），spilled项是超出末级cache的内存流量。
+  static std::array<double, kNumTerms> Terms(
+      const MergeStrategy strategy,
+      const MergeInputFeatures &features) {
+    const double n = features.num_elements;
+    const double k = features.num_runs;
+    const double log_k = Log2(k);
+    const double num_rounds = std::ceil(log_k);
+    // 值域不重叠时sift down很早就停止，堆的有效深度随重叠程度变小。
+    // 堆越深，sift down中的分支越难预测（实测k = 16时每层约3ns，k >= 64
+    // 时约10ns），所以堆的每层代价也随深度增长。
+    const double log_overlapping_k = Log2(1.0 + features.overlap * k);
+    // 两两归并时长run与短run相遇，比较只发生在短run的元素上，其余部分是
+    // 顺序拷贝；长度越不均匀，受比较约束的元素越少。
+    // 重复值连成一段时比较结果不变：堆顶的下一个值与当前值相等时sift down
+    // 立即停止，std::merge的分支容易预测，指数查找一次拷贝整段。
+    const double compared =
+        n * num_rounds / features.length_spread * features.new_value_rate;
+    const double changes = n * features.new_value_rate;
+    const double threads = MergeThreads();
+    // 输入与输出合计的工作集中放不进末级cache的比例；每遍扫描都要为这部分
+    // 付出内存带宽。
+    const double working_set = 2.0 * n * sizeof(int);
+    const double cache = LastLevelCacheBytes();
+    const double spilled =
+        working_set > cache ? n * (1.0 - cache / working_set) : 0.0;
+    switch (strategy) {
+      case MergeStrategy::kHeap:
+        return {{ n, changes * log_overlapping_k,
+                  changes * log_overlapping_k * log_overlapping_k, k,
+                  spilled }};
+      case MergeStrategy::kTournament:
+        return {{ n, n * log_k, k, spilled, 0.0 }};
+      case MergeStrategy::kPairwiseTree:
+        return {{ n, n * num_rounds, compared, spilled * num_rounds, 0.0 }};
+      case MergeStrategy::kGalloping:
+        return {{ n * num_rounds,
+                  changes * num_rounds * features.overlap,
+                  compared * features.overlap,
+                  spilled * num_rounds, 0.0 }};
+      case MergeStrategy::kConcatSort:
+        // 排序的代价取决于不同值的个数，而不是饱和的duplicate_rate；
+        // 快速排序的划分在子数组放进cache之前都是整段扫描。
+        return {{ n, n * Log2(features.distinct_values), k,
+                  spilled * Log2(working_set / cache), 0.0 }};
+      case MergeStrategy::kParallelPartitioned:
+        // 线程的创建与汇合，各线程的堆归并，以及每个线程做两次多序列划分；
+        // 各线程共享内存带宽。
+        return {{ threads, n / threads,
+                  changes * log_overlapping_k * log_overlapping_k / threads,
+                  k * Log2(n), spilled }};
+    }
+    return {};
+  }
+
+  // 预测耗时（秒）
+  double cost(const MergeStrategy strategy,
+              const MergeInputFeatures &features) const {
+    const auto terms = Terms(strategy, features);
+    const auto &coefficients = coefficients_[static_cast<int>(strategy)];
+    double cost = 0.0;
+    for (std::size_t i = 0; i < kNumTerms; ++i) {
+      cost += coefficients[i] * terms[i];
+    }
+    return cost;
+  }
+
+  MergeStrategy choose(const MergeInputFeatures &features) const {
+    MergeStrategy best = MergeStrategy::kHeap;
+    double best_cost = cost(best, features);
+    for (std::size_t s = 1; s < kNumMergeStrategies; ++s) {
+      const MergeStrategy strategy = static_cast<MergeStrategy>(s);
+      const double strategy_cost = cost(strategy, features);
+      if (strategy_cost < best_cost) {
+        best = strategy;
+        best_cost = strategy_cost;
+      }
+    }
+    return best;
+  }
+
+  // 在合成数据上逐个策略计时，并拟合各策略的系数。数据覆盖：
+  //   - 等长、无重复的run：n = max_elements / 1024 .. max_elements，
+  //     k = 2..1024，完全交错、部分重叠、值域不相交三种形态；
+  //   - 长度倾斜的run：第一个run约占一半元素；
+  //   - 大量重复：每个值连续出现16次；
+  //   - 低基数：每个run只有64个不同的值；
+  //   - 超出末级cache的输入：工作集至少为cache的两倍（不超过
+  //     16 * max_elements个元素），完全交错，k = 16和1024。
+  // 小规模的输入重复多次取平均，使线程启动等固定开销也能被拟合出来。
+  // 若某个输入run或某个策略的输出不是有序的，计时没有意义：返回false，
+  // 系数保持不变。
+  bool calibrate(const std::size_t max_elements = 1 << 22) {
+    constexpr std::size_t kMinTimedElements = 1 << 20;
+    std::vector<std::array<double, kNumTerms>> terms[kNumMergeStrategies];
+    std::vector<double> seconds[kNumMergeStrategies];
+    std::vector<int> output;
+
+    const auto measure = [&](const std::vector<std::vector<int>> &arrays) {
+      for (const auto &array : arrays) {
+        if (!std::is_sorted(array.begin(), array.end())) {
+          return false;
+        }
+      }
+      const MergeInputFeatures features = SampleMergeInput(arrays);
+      if (features.num_elements == 0) {
+        return true;
+      }
+      const std::size_t num_repeats =
+          std::max<std::size_t>(1, kMinTimedElements / features.num_elements);
+      output.resize(features.num_elements);
+      for (std::size_t s = 0; s < kNumMergeStrategies; ++s) {
+        const MergeStrategy strategy = static_cast<MergeStrategy>(s);
+        const auto start_time = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < num_repeats; ++r) {
+          RunMergeStrategy(strategy, arrays, &output);
+        }
+        const auto end_time = std::chrono::steady_clock::now();
+        if (!std::is_sorted(output.begin(), output.end())) {
+          return false;
+        }
+        terms[s].emplace_back(Terms(strategy, features));
+        seconds[s].emplace_back(
+            std::chrono::duration<double>(end_time - start_time).count() /
+            num_repeats);
+      }
+      return true;
+    };
+
+    for (const std::size_t num_elements :
+         { max_elements >> 10, max_elements >> 5, max_elements }) {
+      for (const std::size_t k : { 2, 16, 128, 1024 }) {
+        for (const double overlap : { 1.0, 0.25, 0.0 }) {
+          if (!measure(CalibrationInput(num_elements, k, overlap))) {
+            return false;
+          }
+        }
+      }
+    }
+    for (const std::size_t k : { 16, 1024 }) {
+      for (const double overlap : { 1.0, 0.0 }) {
+        if (!measure(CalibrationInput(max_elements >> 2, k, overlap, true)) ||
+            !measure(CalibrationInput(max_elements >> 2, k, overlap, false,
+                                      16))) {
+          return false;
+        }
+      }
+    }
+    for (const std::size_t k : { 2, 16 }) {
+      const std::size_t repeat = std::max<std::size_t>(
+          1, (max_elements >> 2) / (k * 64));
+      for (const double overlap : { 1.0, 0.0 }) {
+        if (!measure(CalibrationInput(max_elements >> 2, k, overlap, false,
+                                      repeat))) {
+          return false;
+        }
+      }
+    }
+    std::size_t spill_elements = max_elements;
+    while (spill_elements < (max_elements << 4) &&
+           2 * spill_elements * sizeof(int) < 2 * LastLevelCacheBytes()) {
+      spill_elements <<= 1;
+    }
+    if (spill_elements > max_elements) {
+      for (const std::size_t k : { 16, 1024 }) {
+        if (!measure(CalibrationInput(spill_elements, k, 1.0))) {
+          return false;
+        }
+      }
+    }
+
+    for (std::size_t s = 0; s < kNumMergeStrategies; ++s) {
+      coefficients_[s] = FitNonNegative(terms[s], seconds[s]);
+    }
+    return true;
+  }
+
+  // 文件格式：首行为版本号，接着两行记录校准时的机器（"threads 线程数"、
+  // "cpu 型号"），之后每行为 "策略名 c0 c1 .."，每个特征项一个系数。
+  bool save(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) {
+      return false;
+    }
+    out << kFileHeader << "\n";
+    out << "threads " << MergeThreads() << "\n";
+    out << "cpu " << CpuModel() << "\n";
+    out.precision(17);
+    for (std::size_t s = 0; s < kNumMergeStrategies; ++s) {
+      out << MergeStrategyName(static_cast<MergeStrategy>(s));
+      for (const double coefficient : coefficients_[s]) {
+        out << " " << coefficient;
+      }
+      out << "\n";
+    }
+    return static_cast<bool>(out);
+  }
+
+  // 版本、线程数或CPU型号与本机不符，缺少某个策略，或系数不是有限的
+  // 非负数时返回false，此时不修改已有的系数。
+  bool load(const std::string &path) {
+    std::ifstream in(path);
+    std::string header, threads, cpu;
+    if (!in || !std::getline(in, header) || header != kFileHeader ||
+        !std::getline(in, threads) ||
+        threads != "threads " + std::to_string(MergeThreads()) ||
+        !std::getline(in, cpu) || cpu != "cpu " + CpuModel()) {
+      return false;
+    }
+    bool loaded[kNumMergeStrategies] = {};
+    std::array<double, kNumTerms> coefficients[kNumMergeStrategies];
+    std::string name;
+    while (in >> name) {
+      std::array<double, kNumTerms> values;
+      for (double &value : values) {
+        in >> value;
+      }
+      if (!in) {
+        return false;
+      }
+      for (const double value : values) {
+        if (!std::isfinite(value) || value < 0.0) {
+          return false;
+        }
+      }
+      for (std::size_t s = 0; s < kNumMergeStrategies; ++s) {
+        if (name == MergeStrategyName(static_cast<MergeStrategy>(s))) {
+          coefficients[s] = values;
+          loaded[s] = true;
+        }
+      }
+    }
+    if (!std::all_of(std::begin(loaded), std::end(loaded),
+                     [](const bool b) { return b; })) {
+      return false;
+    }
+    std::copy(std::begin(coefficients), std::end(coefficients),
+              std::begin(coefficients_));
+    return true;
+  }
+
+  // 启动时调用：优先读取缓存；缓存缺失、版本不符、来自另一台机器或内容
+  // 无效时在本机校准一次并写回，校准失败时不写缓存。
+  // 返回true表示使用的是缓存。
+  bool loadOrCalibrate(const std::string &path) {
+    if (load(path)) {
+      return true;
+    }
+    if (calibrate()) {
+      save(path);
+    }
+    return false;
+  }
+
+ private:
+  static constexpr const char *kFileHeader = "# merge cost model v5";
+
+  // /proc/cpuinfo中第一个"model name"的值；读不到时为"unknown"。
+  static std::string CpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.compare(0, 10, "model name") == 0) {
+        const std::size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+          const std::size_t begin = line.find_first_not_of(' ', colon + 1);
+          if (begin != std::string::npos) {
+            return line.substr(begin);
+          }
+        }
+      }
+    }
+    return "unknown";
+  }
+
+  // 末级cache的大小（字节）；sysconf不支持时按32MiB估计。
+  static std::size_t LastLevelCacheBytes() {
+    static const std::size_t bytes = []() -> std::size_t {
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+      for (const int name : { _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE }) {
+        const long size = sysconf(name);
+        if (size > 0) {
+          return size;
+        }
+      }
+#endif
+      return std::size_t(32) << 20;
+    }();
+    return bytes;
+  }
+
+  static double Log2(const double x) {
+    return std::log2(std::max(x, 2.0));
+  }
+
+  // k个run共约num_elements个元素。run内每个值连续出现repeat次，相邻的
+  // 不同值相距step（默认为k）；最长的run占据长度为 span 的一段值域，相邻
+  // run的值域起点相距 span * (1 - overlap)。overlap为1、不倾斜、不重复时
+  // 即为MergeSortedArrays中完全交错的测试数据。skewed时第一个run的长度
+  // 是其余run的k倍。值域超出int时按比例缩小step与shift，数值先在int64中
+  // 计算。
+  static std::vector<std::vector<int>> CalibrationInput(
+      const std::size_t num_elements,
+      const std::size_t k,
+      const double overlap,
+      const bool skewed = false,
+      const std::size_t repeat = 1) {
+    const std::int64_t num_runs = k;
+    const std::int64_t num_shares = skewed ? 2 * num_runs - 1 : num_runs;
+    const std::int64_t short_length = num_elements / num_shares;
+    const std::int64_t long_length =
+        skewed ? num_elements - short_length * (num_runs - 1) : short_length;
+    const std::int64_t num_steps = (long_length + repeat - 1) / repeat;
+    std::int64_t step = num_runs;
+    std::int64_t shift = num_steps * step * (1.0 - overlap);
+    const auto max_value = [&]() -> std::int64_t {
+      return (num_runs - 1) * (shift + 1) + (num_steps - 1) * step;
+    };
+    const std::int64_t kMaxValue = std::numeric_limits<int>::max();
+    if (max_value() > kMaxValue) {
+      const double scale = static_cast<double>(kMaxValue) / max_value();
+      step = std::max<std::int64_t>(1, step * scale);
+      shift = shift * scale;
+    }
+    assert(max_value() <= kMaxValue);
+
+    std::vector<std::vector<int>> arrays(k);
+    for (std::size_t i = 0; i < k; ++i) {
+      const std::int64_t length = i == 0 ? long_length : short_length;
+      arrays[i].reserve(length);
+      for (std::int64_t j = 0; j < length; ++j) {
+        arrays[i].emplace_back(
+            static_cast<int>(i * shift + i + j / repeat * step));
+      }
+    }
+    return arrays;
+  }
+
+  // 非负最小二乘 y ~ X c（过原点）。特征项只有kNumTerms个，直接枚举
+  // 所有非空的特征项子集：对每个子集解正规方程，在所有系数都非负的解中
+  // 取残差最小者。每行除以 y + kTimeFloor：远大于1ms的点拟合相对误差，
+  // 否则小规模输入上的固定开销项会被大规模输入的绝对误差淹没；更小的点
+  // 权重封顶，以免cache内的小输入主导整个拟合。
+  static std::array<double, kNumTerms> FitNonNegative(
+      const std::vector<std::array<double, kNumTerms>> &x,
+      const std::vector<double> &y) {
+    constexpr double kTimeFloor = 1e-3;
+    std::vector<std::array<double, kNumTerms + 1>> rows;
+    rows.reserve(x.size());
+    for (std::size_t r = 0; r < x.size(); ++r) {
+      if (y[r] > 0.0) {
+        const double weight = 1.0 / (y[r] + kTimeFloor);
+        rows.emplace_back();
+        for (std::size_t i = 0; i < kNumTerms; ++i) {
+          rows.back()[i] = x[r][i] * weight;
+        }
+        rows.back()[kNumTerms] = y[r] * weight;
+      }
+    }
+
+    std::array<double, kNumTerms> best = {};
+    double best_residual = -1.0;
+    for (std::size_t mask = 1; mask < (std::size_t(1) << kNumTerms); ++mask) {
+      std::array<double, kNumTerms> c = {};
+      if (!SolveNormalEquations(rows, mask, &c)) {
+        continue;
+      }
+      double residual = 0.0;
+      for (const auto &row : rows) {
+        double e = row[kNumTerms];
+        for (std::size_t i = 0; i < kNumTerms; ++i) {
+          e -= c[i] * row[i];
+        }
+        residual += e * e;
+      }
+      if (best_residual < 0.0 || residual < best_residual) {
+        best = c;
+        best_residual = residual;
+      }
+    }
+    return best;
+  }
+
+  // rows的每行为 (x0, .., x_{kNumTerms-1}, y)。只用mask中的特征项拟合
+  // y ~ x c，用带部分主元的高斯消元解正规方程；矩阵奇异或有系数为负时
+  // 返回false。
+  static bool SolveNormalEquations(
+      const std::vector<std::array<double, kNumTerms + 1>> &rows,
+      const std::size_t mask,
+      std::array<double, kNumTerms> *c) {
+    std::size_t index[kNumTerms];
+    std::size_t m = 0;
+    for (std::size_t i = 0; i < kNumTerms; ++i) {
+      if (mask >> i & 1) {
+        index[m++] = i;
+      }
+    }
+
+    double a[kNumTerms][kNumTerms + 1] = {};
+    for (const auto &row : rows) {
+      for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+          a[i][j] += row[index[i]] * row[index[j]];
+        }
+        a[i][m] += row[index[i]] * row[kNumTerms];
+      }
+    }
+
+    double diagonal[kNumTerms];
+    for (std::size_t i = 0; i < m; ++i) {
+      diagonal[i] = a[i][i];
+    }
+    for (std::size_t col = 0; col < m; ++col) {
+      std::size_t pivot = col;
+      for (std::size_t r = col + 1; r < m; ++r) {
+        if (std::abs(a[r][col]) > std::abs(a[pivot][col])) {
+          pivot = r;
+        }
+      }
+      if (!(std::abs(a[pivot][col]) > 1e-12 * diagonal[col])) {
+        return false;
+      }
+      std::swap(a[col], a[pivot]);
+      for (std::size_t r = 0; r < m; ++r) {
+        if (r != col) {
+          const double factor = a[r][col] / a[col][col];
+          for (std::size_t j = col; j <= m; ++j) {
+            a[r][j] -= factor * a[col][j];
+          }
+        }
+      }
+    }
+
+    c->fill(0.0);
+    for (std::size_t i = 0; i < m; ++i) {
+      const double value = a[i][m] / a[i][i];
+      if (!(value >= 0.0)) {
+        return false;
+      }
+      (*c)[index[i]] = value;
+    }
+    return true;
+  }
+
+  std::array<double, kNumTerms> coefficients_[kNumMergeStrategies];
+};
+
+
+// 顶层入口：采样输入特征，用代价模型选出预测最快的策略并执行。
+inline MergeStrategy AdaptiveMerge(const std::vector<std::vector<int>> &arrays,
+                                   std::vector<int> *output,
+                                   const MergeCostModel &model) {
+  const MergeStrategy strategy = model.choose(SampleMergeInput(arrays));
+  RunMergeStrategy(strategy, arrays, output);
+  return strategy;
+}
+
+#endif  // ADAPTIVE_MERGE_H_
@@ -0,0 +1,262 @@
+#ifndef COMPRESSED_RUN_H_
+#define COMPRESSED_RUN_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "meta.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////// 差分+位压缩的有序run ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// 每128个值为一个block：
+//   - block头记录首个值base、位宽以及压缩数据在words_中的偏移；
+//   - 采用D4差分：d[i] = v[i] - v[i-4]（前4个值相对base），使解码时的
+//     前缀和在4条lane上相互独立；
+//   - 差分按4路纵向交错布局位压缩：第i个值属于lane i%4，每条lane的32个值
+//     连续打包在该lane自己的32位字序列中（字下标为 4*w + lane）。
+// 因此解码的每一步都是4路相同的移位/掩码/加法，可直接映射为128位SIMD指令。
+// 最后一个block不足128个值时用末尾值补齐。
+
+constexpr std::size_t kCompressedBlockSize = 128;
+
+namespace bitpack {
+
+constexpr std::size_t kNumLanes = 4;
+constexpr std::size_t kValuesPerLane = kCompressedBlockSize / kNumLanes;
+
+// 位宽0..32，用于把运行期的位宽分派到编译期展开的解包函数。
+using BitWidths = meta::Sequence<
+    int, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+    19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32>;
+
+constexpr std::uint32_t LowBitsMask(const int bit_width) {
+  return bit_width >= 32 ? ~0u : (1u << bit_width) - 1;
+}
+
+template <int bit_width>
+inline void UnpackBlock(const std::uint32_t *in, std::uint32_t *out) {
+  constexpr std::uint32_t kMask = LowBitsMask(bit_width);
+  for (std::size_t j = 0; j < kValuesPerLane; ++j) {
+    const std::size_t bit = j * bit_width;
+    const std::size_t w = bit >> 5;
+    const std::size_t shift = bit & 31;
+    for (std::size_t lane = 0; lane < kNumLanes; ++lane) {
+      std::uint32_t value =
+          bit_width == 0 ? 0 : in[w * kNumLanes + lane] >> shift;
+      if (shift + bit_width > 32) {
+        value |= in[(w + 1) * kNumLanes + lane] << ((32 - shift) & 31);
+      }
+      out[j * kNumLanes + lane] = value & kMask;
+    }
+  }
+}
+
+inline void PackBlock(const std::uint32_t *in, const int bit_width,
+                      std::uint32_t *out) {
+  if (bit_width == 0) {
+    return;
+  }
+  for (std::size_t j = 0; j < kValuesPerLane; ++j) {
+    const std::size_t bit = j * bit_width;
+    const std::size_t w = bit >> 5;
+    const std::size_t shift = bit & 31;
+    for (std::size_t lane = 0; lane < kNumLanes; ++lane) {
+      const std::uint32_t value = in[j * kNumLanes + lane];
+      out[w * kNumLanes + lane] |= value << shift;
+      if (shift + bit_width > 32) {
+        out[(w + 1) * kNumLanes + lane] |= value >> (32 - shift);
+      }
+    }
+  }
+}
+
+}  // namespace bitpack
+
+
+class CompressedRun {
+ public:
+  CompressedRun()
+      : size_(0),
+        num_pending_(0) {}
+
+  explicit CompressedRun(const std::vector<int> &values)
+      : CompressedRun() {
+    blocks_.reserve((values.size() + kCompressedBlockSize - 1) /
+                    kCompressedBlockSize);
+    for (const int value : values) {
+      push_back(value);
+    }
+    flush();
+  }
+
+  // 追加一个值，值必须不小于之前追加的值。
+  inline void push_back(const int value) {
+    pending_[num_pending_++] = value;
+    if (num_pending_ == kCompressedBlockSize) {
+      encodePending();
+    }
+  }
+
+  // 把不足一个block的剩余值编码，之后不应再push_back。
+  inline void flush() {
+    if (num_pending_ > 0) {
+      encodePending();
+    }
+  }
+
+  inline std::size_t size() const {
+    return size_;
+  }
+
+  inline std::size_t num_blocks() const {
+    return blocks_.size();
+  }
+
+  // 第block个block中的有效值个数。
+  inline std::size_t block_size(const std::size_t block) const {
+    return block + 1 < blocks_.size()
+               ? kCompressedBlockSize
+               : size_ - block * kCompressedBlockSize;
+  }
+
+  // 压缩后占用的字节数（block头 + 位压缩数据）。
+  inline std::size_t bytes() const {
+    return blocks_.size() * sizeof(BlockHeader) +
+           words_.size() * sizeof(std::uint32_t);
+  }
+
+  // 把第block个block解码到out，out需有kCompressedBlockSize个int的空间。
+  inline void decodeBlock(const std::size_t block, int *out) const {
+    const BlockHeader &header = blocks_[block];
+    std::uint32_t *values = reinterpret_cast<std::uint32_t*>(out);
+    const std::uint32_t *in = words_.data() + header.offset;
+    bitpack::BitWidths::Dispatch(header.bit_width, [&](auto bit_width) {
+      bitpack::UnpackBlock<decltype(bit_width)::value>(in, values);
+    });
+
+    const std::uint32_t base = static_cast<std::uint32_t>(header.base);
+    for (std::size_t i = 0; i < bitpack::kNumLanes; ++i) {
+      values[i] += base;
+    }
+    for (std::size_t i = bitpack::kNumLanes; i < kCompressedBlockSize; ++i) {
+      values[i] += values[i - bitpack::kNumLanes];
+    }
+  }
+
+  void decode(std::vector<int> *output) const {
+    output->resize(blocks_.size() * kCompressedBlockSize);
+    for (std::size_t block = 0; block < blocks_.size(); ++block) {
+      decodeBlock(block, output->data() + block * kCompressedBlockSize);
+    }
+    output->resize(size_);
+  }
+
+ private:
+  struct BlockHeader {
+    int base;
+    std::uint32_t offset;
+    std::uint8_t bit_width;
+  };
+
+  void encodePending() {
+    for (std::size_t i = num_pending_; i < kCompressedBlockSize; ++i) {
+      pending_[i] = pending_[num_pending_ - 1];
+    }
+
+    const std::uint32_t base = static_cast<std::uint32_t>(pending_[0]);
+    std::uint32_t deltas[kCompressedBlockSize];
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kCompressedBlockSize; ++i) {
+      const std::uint32_t prev =
+          i < bitpack::kNumLanes
+              ? base
+              : static_cast<std::uint32_t>(pending_[i - bitpack::kNumLanes]);
+      deltas[i] = static_cast<std::uint32_t>(pending_[i]) - prev;
+      bits |= deltas[i];
+    }
+    int bit_width = 0;
+    while (bit_width < 32 && (bits >> bit_width) != 0) {
+      ++bit_width;
+    }
+
+    const std::size_t offset = words_.size();
+    words_.resize(offset + bit_width * bitpack::kNumLanes, 0);
+    bitpack::PackBlock(deltas, bit_width, words_.data() + offset);
+    blocks_.push_back({ pending_[0],
+                        static_cast<std::uint32_t>(offset),
+                        static_cast<std::uint8_t>(bit_width) });
+
+    size_ += num_pending_;
+    num_pending_ = 0;
+  }
+
+  std::vector<BlockHeader> blocks_;
+  std::vector<std::uint32_t> words_;
+  std::size_t size_;
+
+  int pending_[kCompressedBlockSize];
+  std::size_t num_pending_;
+};
+
+
+// 与ArrayIterator接口相同的游标，每次只把一个block解码到自身的小缓冲区
+// (512字节，常驻L1)，可直接用于BasicMergeHeap。
+class CompressedRunIterator {
+ public:
+  CompressedRunIterator(const CompressedRun &run)
+      : run_(&run),
+        block_(0),
+        current_(buffer_),
+        end_(buffer_) {
+    if (run.num_blocks() > 0) {
+      load();
+    }
+  }
+
+  CompressedRunIterator(const CompressedRunIterator &other)
+      : run_(other.run_),
+        block_(other.block_),
+        current_(buffer_ + (other.current_ - other.buffer_)),
+        end_(buffer_ + (other.end_ - other.buffer_)) {
+    std::copy(other.buffer_, other.end_, buffer_);
+  }
+
+  CompressedRunIterator& operator=(const CompressedRunIterator &other) = delete;
+
+  inline int value() const {
+    return *current_;
+  }
+
+  inline void next() {
+    if (++current_ == end_ && ++block_ < run_->num_blocks()) {
+      load();
+    }
+  }
+
+  inline bool valid() const {
+    return current_ < end_;
+  }
+
+  inline bool operator<(const CompressedRunIterator &other) const {
+    return *current_ < *other.current_;
+  }
+
+ private:
+  inline void load() {
+    run_->decodeBlock(block_, buffer_);
+    current_ = buffer_;
+    end_ = buffer_ + run_->block_size(block_);
+  }
+
+  const CompressedRun *run_;
+  std::size_t block_;
+  const int *current_;
+  const int *end_;
+  alignas(16) int buffer_[kCompressedBlockSize];
+};
+
+#endif  // COMPRESSED_RUN_H_
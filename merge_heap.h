@@ -0,0 +1,127 @@
+#ifndef MERGE_HEAP_H_
+#define MERGE_HEAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// 简易的Iterator
+class ArrayIterator {
+ public:
+  ArrayIterator()
+      : current_(nullptr),
+        end_(nullptr) {}
+
+  ArrayIterator(const std::vector<int> &array)
+      : current_(array.data()),
+        end_(current_ + array.size()) {}
+
+  ArrayIterator(const int *begin, const int *end)
+      : current_(begin),
+        end_(end) {}
+
+  inline int value() const {
+    return *current_;
+  }
+
+  inline void next() {
+    ++current_;
+  }
+
+  inline bool valid() const {
+    return current_ < end_;
+  }
+
+  inline bool operator<(const ArrayIterator &other) const {
+    return *current_< *other.current_;
+  }
+
+ private:
+  const int *current_;
+  const int * const end_;
+};
+
+using ArrayIteratorPointer = ArrayIterator*;
+
+template <bool greater>
+struct ArrayIteratorPointerComparator {
+  inline bool operator()(const ArrayIteratorPointer &lhs,
+                         const ArrayIteratorPointer &rhs) const {
+    return greater ^ (*lhs < *rhs);
+  }
+};
+
+
+// 自定义的多路归并Heap，构造时所有iterator都必须valid。
+// Iterator需要提供与ArrayIterator相同的value/next/valid/operator<接口。
+template <typename Iterator>
+class BasicMergeHeap {
+ public:
+  using IteratorPointer = Iterator*;
+
+  BasicMergeHeap(std::vector<Iterator> *iterators) {
+    heap_.reserve(iterators->size());
+    for (Iterator &it : *iterators) {
+      heap_.emplace_back(&it);
+    }
+    std::sort(heap_.begin(), heap_.end(),
+              [](const IteratorPointer &lhs, const IteratorPointer &rhs) {
+                return *lhs < *rhs;
+              });
+  }
+
+  inline bool empty() const {
+    return heap_.empty();
+  }
+
+  inline int next() {
+    const IteratorPointer &top = heap_.front();
+    const int value = top->value();
+    top->next();
+    if (!top->valid()) {
+      heap_.front() = heap_.back();
+      heap_.pop_back();
+    }
+    if (heap_.size() > 1) {
+      siftDown();
+    }
+    return value;
+  }
+
+ private:
+  inline void siftDown() {
+    const IteratorPointer node = heap_.front();
+    const std::size_t n = heap_.size();
+    const std::size_t b = n >> 1;
+    std::size_t k = 0;
+    while (k < b) {
+      const std::size_t l = (k << 1) + 1;
+      const IteratorPointer lnode = heap_[l];
+
+      const std::size_t r = l + 1;
+      IteratorPointer rnode;
+      if (r >= n || *lnode < *(rnode = heap_[r])) {
+        if (*lnode < *node) {
+          heap_[k] = lnode;
+          k = l;
+        } else {
+          break;
+        }
+      } else {
+        if (*rnode < *node) {
+          heap_[k] = rnode;
+          k = r;
+        } else {
+          break;
+        }
+      }
+    }
+    heap_[k] = node;
+  }
+
+  std::vector<IteratorPointer> heap_;
+};
+
+using MergeHeap = BasicMergeHeap<ArrayIterator>;
+
+#endif  // MERGE_HEAP_H_
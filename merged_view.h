@@ -0,0 +1,111 @@
+#ifndef MERGED_VIEW_H_
+#define MERGED_VIEW_H_
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "merge_heap.h"
+
+// 惰性的多路归并视图（C++20 input_range + view）。
+//
+// 不需要预先分配整个输出：每次解引用/自增只从BasicMergeHeap中取出一个
+// 元素，常驻内存为O(k)。下游的filter/transform/take等操作与归并融合在同
+// 一个循环里，提前终止时只为实际消费的元素付出代价。
+//
+// heap_中保存的是指向iterators_元素的指针；移动std::vector不会搬动其元素，
+// 所以视图可以移动，但不能复制。
+template <typename Iterator = ArrayIterator>
+class MergedView : public std::ranges::view_interface<MergedView<Iterator>> {
+ public:
+  class iterator {
+   public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    explicit iterator(MergedView *view)
+        : view_(view) {}
+
+    inline int operator*() const {
+      return view_->current_;
+    }
+
+    inline iterator& operator++() {
+      view_->advance();
+      return *this;
+    }
+
+    inline void operator++(int) {
+      view_->advance();
+    }
+
+    inline friend bool operator==(const iterator &it,
+                                  std::default_sentinel_t) {
+      return it.done();
+    }
+
+   private:
+    inline bool done() const {
+      return view_->done_;
+    }
+
+    MergedView *view_ = nullptr;
+  };
+
+  // runs中的每个元素都用于构造一个Iterator，例如std::vector<int>或
+  // CompressedRun；空的run会被跳过。
+  template <typename Runs>
+  explicit MergedView(const Runs &runs)
+      : iterators_(MakeIterators(runs)),
+        heap_(&iterators_) {}
+
+  MergedView(MergedView &&other) = default;
+  MergedView& operator=(MergedView &&other) = default;
+
+  // 单遍视图：begin()只能调用一次。
+  inline iterator begin() {
+    advance();
+    return iterator(this);
+  }
+
+  inline std::default_sentinel_t end() const {
+    return std::default_sentinel;
+  }
+
+ private:
+  template <typename Runs>
+  static std::vector<Iterator> MakeIterators(const Runs &runs) {
+    std::vector<Iterator> iterators;
+    iterators.reserve(std::size(runs));
+    for (const auto &run : runs) {
+      iterators.emplace_back(run);
+      if (!iterators.back().valid()) {
+        iterators.pop_back();
+      }
+    }
+    return iterators;
+  }
+
+  inline void advance() {
+    if (heap_.empty()) {
+      done_ = true;
+    } else {
+      current_ = heap_.next();
+    }
+  }
+
+  std::vector<Iterator> iterators_;
+  BasicMergeHeap<Iterator> heap_;
+  int current_ = 0;
+  bool done_ = false;
+};
+
+template <typename Runs>
+MergedView(const Runs &runs) -> MergedView<ArrayIterator>;
+
+#endif  // MERGED_VIEW_H_
@@ -0,0 +1,358 @@
+#ifndef META_H_
+#define META_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////// 运行期的值到模板实例的分派 ///////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace meta {
+
+namespace internal {
+
+// ---------------------------------------------------------------------------
+// Sequence::Dispatch的实现：编译期为Sequence中的每个值生成一个模板实例，
+// 并用一个完美哈希的跳转表将运行期的值映射到对应的实例。
+
+// 跳转表的最大长度，超过此长度仍找不到无冲突的模数时编译失败。
+constexpr std::size_t kMaxDispatchTableSize = 1024;
+
+template <typename T>
+constexpr std::uint64_t DispatchKey(const T value) {
+  return static_cast<std::uint64_t>(
+      static_cast<std::make_unsigned_t<T>>(value));
+}
+
+template <typename T, T ...s>
+struct SequenceDispatcher {
+  static constexpr std::size_t kNumValues = sizeof...(s);
+
+  // 找到最小的表长size，使得所有值在 key % size 下互不冲突。
+  static constexpr std::size_t FindTableSize() {
+    const std::uint64_t keys[] = { DispatchKey(s)..., 0 };
+    for (std::size_t size = kNumValues > 0 ? kNumValues : 1;
+         size <= kMaxDispatchTableSize; ++size) {
+      bool collision = false;
+      for (std::size_t i = 0; i < kNumValues && !collision; ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+          if (keys[i] % size == keys[j] % size) {
+            collision = true;
+            break;
+          }
+        }
+      }
+      if (!collision) {
+        return size;
+      }
+    }
+    return 0;
+  }
+
+  static constexpr std::size_t kTableSize = FindTableSize();
+  static_assert(kTableSize != 0,
+                "Sequence::Dispatch requires distinct values that admit a "
+                "perfect hash table of bounded size");
+
+  template <typename Functor>
+  struct JumpTable {
+    using Handler = void (*)(Functor &);
+
+    struct Entry {
+      T value;
+      Handler handler;
+    };
+
+    struct Entries {
+      Entry slots[kTableSize];
+    };
+
+    template <T v>
+    static void Invoke(Functor &functor) {
+      functor(std::integral_constant<T, v>());
+    }
+
+    static constexpr Entries Build() {
+      Entries entries{};
+      const T values[] = { s..., T() };
+      const Handler handlers[] = { &Invoke<s>..., nullptr };
+      for (std::size_t i = 0; i < kNumValues; ++i) {
+        Entry &slot = entries.slots[DispatchKey(values[i]) % kTableSize];
+        slot.value = values[i];
+        slot.handler = handlers[i];
+      }
+      return entries;
+    }
+
+    inline static const Entry& Lookup(const T value) {
+      static const Entries entries = Build();
+      return entries.slots[DispatchKey(value) % kTableSize];
+    }
+  };
+
+  template <typename Functor>
+  inline static bool Dispatch(const T value, Functor &functor) {
+    const auto &entry = JumpTable<Functor>::Lookup(value);
+    if (entry.handler == nullptr || entry.value != value) {
+      return false;
+    }
+    entry.handler(functor);
+    return true;
+  }
+};
+
+// UnsignedInteger
+template <std::size_t num_bytes, typename Enable = void>
+struct UnsignedIntegerImpl {
+  static_assert(num_bytes <= sizeof(std::uint64_t),
+                "No unsigned integer type is wide enough");
+};
+
+template <std::size_t num_bytes>
+struct UnsignedIntegerImpl<num_bytes, std::enable_if_t<num_bytes <= 1>> {
+  using type = std::uint8_t;
+};
+
+template <std::size_t num_bytes>
+struct UnsignedIntegerImpl<
+    num_bytes, std::enable_if_t<(num_bytes > 1 && num_bytes <= 2)>> {
+  using type = std::uint16_t;
+};
+
+template <std::size_t num_bytes>
+struct UnsignedIntegerImpl<
+    num_bytes, std::enable_if_t<(num_bytes > 2 && num_bytes <= 4)>> {
+  using type = std::uint32_t;
+};
+
+template <std::size_t num_bytes>
+struct UnsignedIntegerImpl<
+    num_bytes, std::enable_if_t<(num_bytes > 4 && num_bytes <= 8)>> {
+  using type = std::uint64_t;
+};
+
+}  // namespace internal
+
+// 能容纳至少num_bytes个字节的最小无符号整数类型。
+template <std::size_t num_bytes>
+using UnsignedInteger = typename internal::UnsignedIntegerImpl<num_bytes>::type;
+
+}  // namespace meta
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////// TypeList的一个minimal实现 /////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace meta {
+
+template <typename T, T ...s>
+struct Sequence {
+  using value_type = T;
+
+  template <template <typename ...> class Host>
+  using bind_to = Host<std::integral_constant<T, s>...>;
+
+  template <typename CollectionT>
+  inline static CollectionT Instantiate() {
+    return { s... };
+  }
+
+  // 若运行期的value等于序列中的某个值v，则调用
+  // functor(std::integral_constant<T, v>()) 并返回true，否则返回false。
+  // 分派通过编译期生成的完美哈希跳转表完成，不需要手写switch。
+  template <typename Functor>
+  inline static bool Dispatch(const T value, Functor &&functor) {
+    return internal::SequenceDispatcher<T, s...>::template Dispatch<
+        std::remove_reference_t<Functor>>(value, functor);
+  }
+};
+
+template <typename ...Ts>
+struct TypeList;
+
+namespace internal {
+
+using EmptyList = TypeList<>;
+
+// ---------------------------------------------------------------------------
+// TypeList meta functions.
+
+// TypeList::at
+template <typename TL, typename PosTL, typename Enable = void>
+struct ElementAtImpl;
+
+template <typename TL, typename PosTL>
+struct ElementAtImpl<TL, PosTL, std::enable_if_t<PosTL::length == 0>> {
+  using type = TL;
+};
+
+// TypeList::append
+template <typename TL, typename UL>
+struct AppendImpl;
+
+template <typename ...Ts, typename ...Us>
+struct AppendImpl<TypeList<Ts...>, TypeList<Us...>> {
+  using type = TypeList<Ts..., Us...>;
+};
+
+template <typename TL, typename PosTL>
+struct ElementAtImpl<TL, PosTL, std::enable_if_t<PosTL::length != 0>>
+    : ElementAtImpl<typename std::tuple_element<
+                        PosTL::head::value,
+                        typename TL::template bind_to<std::tuple>>::type,
+                    typename PosTL::tail> {};
+
+// TypeList::filter
+template <typename Out, typename Rest, template <typename ...> class Op,
+          typename Enable = void>
+struct FilterImpl;
+
+template <typename Out, typename Rest, template <typename ...> class Op>
+struct FilterImpl<Out, Rest, Op, std::enable_if_t<Rest::length == 0>> {
+  using type = Out;
+};
+
+template <typename Out, typename Rest, template <typename ...> class Op>
+struct FilterImpl<Out, Rest, Op, std::enable_if_t<Op<typename Rest::head>::value>>
+    : FilterImpl<typename Out::template push_back<typename Rest::head>,
+                 typename Rest::tail, Op> {};
+
+template <typename Out, typename Rest, template <typename ...> class Op>
+struct FilterImpl<Out, Rest, Op, std::enable_if_t<!Op<typename Rest::head>::value>>
+    : FilterImpl<Out, typename Rest::tail, Op> {};
+
+// TypeList::foldl
+template <typename Out, typename Rest, template <typename ...> class Op,
+          typename Enable = void>
+struct FoldlImpl;
+
+template <typename Out, typename Rest, template <typename ...> class Op>
+struct FoldlImpl<Out, Rest, Op, std::enable_if_t<Rest::length == 0>> {
+  using type = Out;
+};
+
+template <typename Out, typename Rest, template <typename ...> class Op>
+struct FoldlImpl<Out, Rest, Op, std::enable_if_t<Rest::length != 0>>
+    : FoldlImpl<typename Op<Out, typename Rest::head>::type,
+                typename Rest::tail, Op> {};
+
+// TypeList::get
+template <typename TL, typename T, typename Enable = void>
+struct GetValueForKeyImpl {
+  static_assert(TL::length != 0, "TypeObject does not contain the required key.");
+};
+
+template <typename TL, typename T>
+struct GetValueForKeyImpl<
+    TL, T, std::enable_if_t<TL::length != 0 &&
+                            std::is_same<typename TL::head::head, T>::value>> {
+  using type = typename TL::head::tail::head;
+};
+
+template <typename TL, typename T>
+struct GetValueForKeyImpl<
+    TL, T, std::enable_if_t<TL::length != 0 &&
+                            !std::is_same<typename TL::head::head, T>::value>>
+    : GetValueForKeyImpl<typename TL::tail, T> {};
+
+// TypeList::reverse
+template <typename Out, typename Rest, typename Enable = void>
+struct ReverseImpl;
+
+template <typename Out, typename Rest>
+struct ReverseImpl<Out, Rest, std::enable_if_t<Rest::length == 0>> {
+  using type = Out;
+};
+
+template <typename Out, typename Rest>
+struct ReverseImpl<Out, Rest, std::enable_if_t<Rest::length != 0>>
+    : ReverseImpl<typename Out::template push_front<typename Rest::head>,
+                  typename Rest::tail> {};
+
+// TypeList::zip
+template <typename Out, typename RestL, typename RestR, typename Enable = void>
+struct ZipImpl;
+
+template <typename Out, typename RestL, typename RestR>
+struct ZipImpl<Out, RestL, RestR,
+               std::enable_if_t<RestL::length == 0 || RestR::length == 0>> {
+  static_assert(RestL::length == 0 && RestR::length == 0,
+                "Zip failed: TypeLists have unequal lengths");
+  using type = Out;
+};
+
+template <typename Out, typename RestL, typename RestR>
+struct ZipImpl<Out, RestL, RestR,
+               std::enable_if_t<RestL::length != 0 && RestR::length != 0>>
+    : ZipImpl<typename Out::template push_back<
+                  TypeList<typename RestL::head, typename RestR::head>>,
+              typename RestL::tail, typename RestR::tail> {};
+
+// ---------------------------------------------------------------------------
+// End of meta functions.
+
+template <typename ...Ts>
+struct TypeListBase {
+  static constexpr std::size_t length = sizeof...(Ts);
+
+  using type = TypeList<Ts...>;
+  using self = type;
+
+  // ---------------------------------------------------------------------------
+  // Meta-methods.
+
+  template <template <typename ...> class Host>
+  using bind_to = Host<Ts...>;
+
+  template <typename TL>
+  using append = typename AppendImpl<self, TL>::type;
+
+  template <std::size_t ...pos>
+  using at = typename ElementAtImpl<
+      self, TypeList<std::integral_constant<std::size_t, pos>...>>::type;
+
+  template <typename T>
+  using push_front = TypeList<T, Ts...>;
+
+  template <typename T>
+  using push_back = TypeList<Ts..., T>;
+
+  template <typename Key>
+  using get = typename GetValueForKeyImpl<self, Key>::type;
+
+  template <template <typename ...> class Op>
+  using map = TypeList<typename Op<Ts>::type...>;
+
+  template <template <typename ...> class Op>
+  using filter = typename FilterImpl<EmptyList, self, Op>::type;
+
+  template <template <typename ...> class Op, typename InitT>
+  using foldl = typename FoldlImpl<InitT, self, Op>::type;
+
+  template <typename ...Dumb>
+  using reverse = typename ReverseImpl<EmptyList, self, Dumb...>::type;
+
+  template <typename TL>
+  using zip = typename ZipImpl<EmptyList, self, TL>::type;
+};
+
+}  // namespace internal
+
+template <typename T, typename ...Ts>
+struct TypeList<T, Ts...> : public internal::TypeListBase<T, Ts...> {
+ public:
+  using head = T;
+  using tail = TypeList<Ts...>;
+};
+
+template <>
+struct TypeList<> : public internal::TypeListBase<> {};
+
+}  // namespace meta
+
+#endif  // META_H_
@@ -0,0 +1,70 @@
+#ifndef MULTISEQ_PARTITION_H_
+#define MULTISEQ_PARTITION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 有序run [first, second)
+using Run = std::pair<const int*, const int*>;
+
+template <typename Functor>
+inline void RunInParallel(const std::size_t num_threads,
+                          const Functor &functor) {
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back(functor, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// 多序列划分（参见multiseq_partition.pdf）：在若干有序run中选出前rank小
+// 的元素，splits[i]为第i个run的划分位置。先二分查找第rank小的值v，小于v
+// 的元素全部取走，剩余名额按run的顺序从等于v的元素中分配，因此不同rank
+// 的划分点在每个run上单调不减。
+inline void MultiSequenceSplit(const std::vector<Run> &runs,
+                               const std::size_t rank,
+                               std::vector<const int*> *splits) {
+  const auto count_not_greater = [&runs](const std::int64_t value) {
+    std::size_t count = 0;
+    for (const Run &run : runs) {
+      count += std::upper_bound(run.first, run.second, value) - run.first;
+    }
+    return count;
+  };
+
+  std::int64_t lo = std::numeric_limits<int>::min();
+  std::int64_t hi = std::numeric_limits<int>::max();
+  while (lo < hi) {
+    const std::int64_t mid = lo + ((hi - lo) >> 1);
+    if (count_not_greater(mid) >= rank) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  const int value = static_cast<int>(lo);
+
+  splits->resize(runs.size());
+  std::size_t remaining = rank;
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    (*splits)[i] = std::lower_bound(runs[i].first, runs[i].second, value);
+    remaining -= (*splits)[i] - runs[i].first;
+  }
+  for (std::size_t i = 0; i < runs.size() && remaining > 0; ++i) {
+    const int *last = std::upper_bound((*splits)[i], runs[i].second, value);
+    const std::size_t num_equal =
+        std::min<std::size_t>(last - (*splits)[i], remaining);
+    (*splits)[i] += num_equal;
+    remaining -= num_equal;
+  }
+}
+
+#endif  // MULTISEQ_PARTITION_H_